@@ -1,4 +1,5 @@
 #include "perf_event_open_tool.h"
+#include "perf_regression_check.h"
 #include <iostream>
 #include <fstream>
 #include <map>
@@ -135,6 +136,41 @@ void multi_raw_event_test(){
     }
 }
 #endif
+void regression_check_test(){
+    // 重复运行多次，得到每个事件的计数分布
+    const int runs = 5;
+    std::vector<PerfEventOpenTool::EventType> events = {
+        PerfEventOpenTool::EventType::INSTRUCTIONS,
+        PerfEventOpenTool::EventType::CACHE_MISSES,
+    };
+    PerfRegressionCheck current;
+    for (int i = 0; i < runs; ++i) {
+        PerfEventOpenTool tool(events);
+        tool.start();
+        my_code();
+        tool.stop();
+        current.addRun("my_code", tool);
+    }
+
+    // 首次运行时保存为基线，之后与基线对比
+    std::string baseline_path = "perf_baseline.txt";
+    std::ifstream ifs(baseline_path);
+    if (!ifs) {
+        current.save(baseline_path);
+        std::cout << "baseline saved to " << baseline_path << std::endl;
+        return;
+    }
+    PerfRegressionCheck baseline;
+    baseline.load(baseline_path);
+    PerfRegressionCheck::Thresholds th;
+    th.per_event["CACHE_MISSES"] = 0.05; // cache miss噪声较大，放宽到5%
+    auto diffs = current.compare(baseline, th);
+    PerfRegressionCheck::printDiffTable(diffs, std::cout);
+    if (PerfRegressionCheck::hasRegression(diffs)) {
+        std::cout << "performance regression check failed" << std::endl;
+    }
+}
+
 void multi_raw_event_test2(){
     std::cout << "multi_raw_event_test2" << std::endl;
 }
@@ -152,5 +188,7 @@ int main() {
 
     // multi_event_test();
 
+    // regression_check_test();
+
     multi_raw_event_test();
 }
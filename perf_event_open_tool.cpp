@@ -184,16 +184,22 @@ std::map<std::string, uint64_t> PerfEventOpenTool::getResults() const {
     return res;
 }
 
+// 有自定义名字时用自定义名字，否则用事件类型名
+std::string PerfEventOpenTool::eventName(size_t idx) const {
+    if (idx < event_names_.size()) return event_names_[idx];
+    return eventTypeToString(events_[idx].type, events_[idx].raw_config);
+}
+
 void PerfEventOpenTool::printResults() const {
-    for (const auto& e : events_) {
-        std::cout << eventTypeToString(e.type, e.raw_config) << ": " << e.value << std::endl;
+    for (size_t i = 0; i < events_.size(); ++i) {
+        std::cout << eventName(i) << ": " << events_[i].value << std::endl;
     }
 }
 
 void PerfEventOpenTool::logResults(const std::string& log_path) const {
     std::ofstream ofs(log_path, std::ios::app);
-    for (const auto& e : events_) {
-        ofs << eventTypeToString(e.type, e.raw_config) << ": " << e.value << std::endl;
+    for (size_t i = 0; i < events_.size(); ++i) {
+        ofs << eventName(i) << ": " << events_[i].value << std::endl;
     }
 }
 
@@ -287,11 +293,11 @@ uint64_t PerfEventOpenTool::getResultByName(const std::string& name) const {
     throw std::runtime_error("Event name not found");
 }
 
-// 实现获取所有自定义名字的事件计数结果
+// 实现获取所有事件计数结果（自定义名字优先）
 std::map<std::string, uint64_t> PerfEventOpenTool::getResultsByName() const {
     std::map<std::string, uint64_t> res;
-    for (size_t i = 0; i < event_names_.size() && i < events_.size(); ++i) {
-        res[event_names_[i]] = events_[i].value;
+    for (size_t i = 0; i < events_.size(); ++i) {
+        res[eventName(i)] = events_[i].value;
     }
     return res;
 }
@@ -92,12 +92,16 @@ public:
     std::map<std::string, uint64_t> getResults() const;
 
     /**
-     * @brief 结果输出到标准输出
+     * @brief 结果输出到标准输出，每行"事件名: 计数值"
+     *
+     * 事件名与getResultsByName()一致：有自定义名字时用自定义名字，否则用事件类型名。
      */
     void printResults() const;
 
     /**
-     * @brief 结果输出到日志文件
+     * @brief 结果追加输出到日志文件，格式与printResults()相同
+     *
+     * 多次运行追加到同一文件后，可用 perf_regress import 导入为回归基线。
      * @param log_path 日志文件路径
      */
     void logResults(const std::string& log_path) const;
@@ -139,7 +143,7 @@ public:
      */
     uint64_t getResultByName(const std::string& name) const;
     /**
-     * @brief 获取所有自定义名字的事件计数结果
+     * @brief 获取所有事件的计数结果，有自定义名字的事件用自定义名字，其余用事件类型名
      * @return 名字到计数的映射
      */
     std::map<std::string, uint64_t> getResultsByName() const;
@@ -163,6 +167,7 @@ private:
     int group_leader_fd_ = -1;
     void openEvents(const std::vector<EventType>& events, const std::vector<uint64_t>& raw_configs);
     static std::string eventTypeToString(EventType type, uint64_t raw_config = 0);
+    std::string eventName(size_t idx) const;
     std::vector<std::string> event_names_;
     std::map<std::string, size_t> name2idx_;
 };
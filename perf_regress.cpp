@@ -0,0 +1,144 @@
+// 性能回归检查命令行工具
+//
+// 用法：
+//   perf_regress compare <baseline> <current> [-a alpha] [-t rel_threshold] [-e EVENT=rel_threshold]... [-n min_runs] [--allow-missing]
+//       对比两个基线文件，打印差异表；存在回归或基线中的指标在本次运行中缺失时返回1，
+//       任一侧运行次数少于min_runs（默认4）时只按相对变化阈值判定；
+//       --allow-missing 时缺失的指标不视为失败
+//   perf_regress import <baseline> <region> <log_path>...
+//       将logResults()输出的日志（每行"EVENT: value"，多次运行追加到同一文件）
+//       导入到基线文件的指定region中，基线文件已存在时追加样本；
+//       日志中任一行的值不是无符号十进制整数时报错（附文件名和行号），不写文件；
+//       导入后该region下各事件的样本数必须相同（日志交错或截断时报错，不写文件）
+//   perf_regress show <baseline>
+//       打印基线文件中每个指标的运行次数、中位数、最小值和最大值
+//
+// 返回值：0 通过，1 存在回归或缺失指标，2 参数或文件错误（含alpha不在(0,1)内、阈值为负数或nan）
+#include "perf_regression_check.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <cstdlib>
+#include <cerrno>
+#include <stdexcept>
+
+namespace {
+    void usage() {
+        std::cerr << "usage:\n"
+                  << "  perf_regress compare <baseline> <current> [-a alpha] [-t rel_threshold] [-e EVENT=rel_threshold]... [-n min_runs] [--allow-missing]\n"
+                  << "  perf_regress import <baseline> <region> <log_path>...\n"
+                  << "  perf_regress show <baseline>\n";
+    }
+
+    double parseDouble(const std::string& s) {
+        char* end = nullptr;
+        double v = std::strtod(s.c_str(), &end);
+        if (s.empty() || *end != '\0') throw std::runtime_error("invalid number: " + s);
+        return v;
+    }
+
+    size_t parseCount(const std::string& s) {
+        char* end = nullptr;
+        if (s.empty() || s[0] < '0' || s[0] > '9') throw std::runtime_error("invalid count: " + s);
+        errno = 0;
+        unsigned long v = std::strtoul(s.c_str(), &end, 10);
+        if (*end != '\0') throw std::runtime_error("invalid count: " + s);
+        if (errno == ERANGE) throw std::runtime_error("count out of range: " + s);
+        return static_cast<size_t>(v);
+    }
+
+    bool fileExists(const std::string& path) {
+        std::ifstream ifs(path);
+        return ifs.good();
+    }
+
+    int cmdCompare(int argc, char** argv) {
+        if (argc < 4) { usage(); return 2; }
+        PerfRegressionCheck::Thresholds th;
+        for (int i = 4; i < argc; ++i) {
+            std::string opt = argv[i];
+            if (opt == "--allow-missing") {
+                th.allow_missing = true;
+                continue;
+            }
+            if (i + 1 >= argc) { usage(); return 2; }
+            std::string val = argv[++i];
+            if (opt == "-a") {
+                th.alpha = parseDouble(val);
+            } else if (opt == "-t") {
+                th.rel_threshold = parseDouble(val);
+            } else if (opt == "-n") {
+                th.min_runs = parseCount(val);
+            } else if (opt == "-e") {
+                size_t pos = val.find('=');
+                if (pos == std::string::npos || pos == 0) throw std::runtime_error("expected EVENT=rel_threshold: " + val);
+                th.per_event[val.substr(0, pos)] = parseDouble(val.substr(pos + 1));
+            } else {
+                usage();
+                return 2;
+            }
+        }
+        PerfRegressionCheck baseline, current;
+        baseline.load(argv[2]);
+        current.load(argv[3]);
+        auto diffs = current.compare(baseline, th);
+        PerfRegressionCheck::printDiffTable(diffs, std::cout);
+        if (PerfRegressionCheck::hasRegression(diffs)) {
+            std::cout << "performance regression check failed" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    int cmdImport(int argc, char** argv) {
+        if (argc < 5) { usage(); return 2; }
+        std::string baseline_path = argv[2];
+        std::string region = argv[3];
+        PerfRegressionCheck check;
+        if (fileExists(baseline_path)) check.load(baseline_path);
+        for (int i = 4; i < argc; ++i) {
+            check.importLog(argv[i], region);
+        }
+
+        // 每次运行记录全部事件，各事件样本数不同说明日志交错或被截断
+        std::ostringstream counts;
+        bool consistent = true;
+        size_t expected = 0;
+        for (const auto& event : check.getEvents(region)) {
+            size_t runs = check.getSamples(region, event).size();
+            if (expected == 0) expected = runs;
+            if (runs != expected) consistent = false;
+            counts << " " << event << "=" << runs;
+        }
+        if (expected == 0) throw std::runtime_error("no samples found for region " + region);
+        if (!consistent) {
+            throw std::runtime_error("events in region " + region + " have different sample counts:" + counts.str());
+        }
+        check.save(baseline_path);
+        return 0;
+    }
+
+    int cmdShow(int argc, char** argv) {
+        if (argc != 3) { usage(); return 2; }
+        PerfRegressionCheck check;
+        check.load(argv[2]);
+        check.printSummary(std::cout);
+        return 0;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) { usage(); return 2; }
+    std::string cmd = argv[1];
+    try {
+        if (cmd == "compare") return cmdCompare(argc, argv);
+        if (cmd == "import") return cmdImport(argc, argv);
+        if (cmd == "show") return cmdShow(argc, argv);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "perf_regress: " << e.what() << std::endl;
+        return 2;
+    }
+    usage();
+    return 2;
+}
@@ -0,0 +1,450 @@
+#include "perf_regression_check.h"
+#include "perf_event_open_tool.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <stdexcept>
+#include <cerrno>
+#include <cstdlib>
+
+namespace {
+    const char* kBaselineHeader = "# perf_regression_baseline v1";
+
+    bool isValidName(const std::string& name) {
+        if (name.empty()) return false;
+        for (char c : name) {
+            if (c == ' ' || c == '\t' || c == '\n' || c == '\r') return false;
+        }
+        return true;
+    }
+
+    // 仅接受十进制无符号整数，拒绝负号、空串与溢出（strtoull会把"-5"静默转为极大值）
+    bool parseUnsigned(const std::string& token, uint64_t& value) {
+        if (token.empty()) return false;
+        for (char c : token) {
+            if (c < '0' || c > '9') return false;
+        }
+        errno = 0;
+        unsigned long long v = std::strtoull(token.c_str(), nullptr, 10);
+        if (errno == ERANGE) return false;
+        value = static_cast<uint64_t>(v);
+        return true;
+    }
+
+    // alpha须在(0,1)内，相对变化阈值须非负；比较写法同时排除NaN
+    void validateThresholds(const PerfRegressionCheck::Thresholds& thresholds) {
+        if (!(thresholds.alpha > 0.0 && thresholds.alpha < 1.0)) {
+            throw std::runtime_error("alpha must be in (0, 1): " + std::to_string(thresholds.alpha));
+        }
+        if (!(thresholds.rel_threshold >= 0.0)) {
+            throw std::runtime_error("relative threshold must be non-negative: " + std::to_string(thresholds.rel_threshold));
+        }
+        for (const auto& kv : thresholds.per_event) {
+            if (!(kv.second >= 0.0)) {
+                throw std::runtime_error("relative threshold for " + kv.first + " must be non-negative: " + std::to_string(kv.second));
+            }
+        }
+    }
+}
+
+void PerfRegressionCheck::addSample(const std::string& region, const std::string& event, uint64_t value) {
+    if (!isValidName(region) || !isValidName(event)) {
+        throw std::runtime_error("region/event name must be non-empty and contain no whitespace");
+    }
+    samples_[region][event].push_back(value);
+}
+
+void PerfRegressionCheck::addRun(const std::string& region, const std::map<std::string, uint64_t>& results) {
+    for (const auto& kv : results) {
+        addSample(region, kv.first, kv.second);
+    }
+}
+
+void PerfRegressionCheck::addRun(const std::string& region, const PerfEventOpenTool& tool) {
+    addRun(region, tool.getResultsByName());
+}
+
+std::vector<uint64_t> PerfRegressionCheck::getSamples(const std::string& region, const std::string& event) const {
+    auto r_it = samples_.find(region);
+    if (r_it == samples_.end()) return {};
+    auto e_it = r_it->second.find(event);
+    if (e_it == r_it->second.end()) return {};
+    return e_it->second;
+}
+
+std::vector<std::string> PerfRegressionCheck::getEvents(const std::string& region) const {
+    std::vector<std::string> events;
+    auto r_it = samples_.find(region);
+    if (r_it == samples_.end()) return events;
+    for (const auto& e : r_it->second) events.push_back(e.first);
+    return events;
+}
+
+bool PerfRegressionCheck::empty() const {
+    return samples_.empty();
+}
+
+void PerfRegressionCheck::clear() {
+    samples_.clear();
+}
+
+void PerfRegressionCheck::save(const std::string& path) const {
+    std::ofstream ofs(path, std::ios::trunc);
+    if (!ofs) throw std::runtime_error("cannot open baseline file for writing: " + path);
+    ofs << kBaselineHeader << "\n";
+    for (const auto& r : samples_) {
+        for (const auto& e : r.second) {
+            ofs << r.first << " " << e.first << " " << e.second.size();
+            for (uint64_t v : e.second) ofs << " " << v;
+            ofs << "\n";
+        }
+    }
+    if (!ofs) throw std::runtime_error("failed to write baseline file: " + path);
+}
+
+void PerfRegressionCheck::load(const std::string& path) {
+    std::ifstream ifs(path);
+    if (!ifs) throw std::runtime_error("cannot open baseline file: " + path);
+    std::string line;
+    if (!std::getline(ifs, line) || line != kBaselineHeader) {
+        throw std::runtime_error(path + ": not a baseline file (expected header \"" + std::string(kBaselineHeader) + "\")");
+    }
+    size_t line_no = 1;
+    // 先完整解析再合并，出错时不留下半份数据
+    std::map<std::string, std::map<std::string, std::vector<uint64_t>>> loaded;
+    while (std::getline(ifs, line)) {
+        ++line_no;
+        if (line.empty() || line[0] == '#') continue;
+        const std::string where = path + ":" + std::to_string(line_no) + ": ";
+        std::istringstream iss(line);
+        std::string region, event, token;
+        uint64_t n = 0;
+        if (!(iss >> region >> event >> token) || !parseUnsigned(token, n)) {
+            throw std::runtime_error(where + "malformed baseline line");
+        }
+        if (n == 0) throw std::runtime_error(where + "sample count must be positive");
+        std::vector<uint64_t> values;
+        while (iss >> token) {
+            uint64_t v = 0;
+            if (!parseUnsigned(token, v)) throw std::runtime_error(where + "invalid sample value: " + token);
+            values.push_back(v);
+        }
+        if (values.size() != n) {
+            throw std::runtime_error(where + "expected " + std::to_string(n) + " samples, got " + std::to_string(values.size()));
+        }
+        std::vector<uint64_t>& dst = loaded[region][event];
+        dst.insert(dst.end(), values.begin(), values.end());
+    }
+    for (const auto& r : loaded) {
+        for (const auto& e : r.second) {
+            std::vector<uint64_t>& dst = samples_[r.first][e.first];
+            dst.insert(dst.end(), e.second.begin(), e.second.end());
+        }
+    }
+}
+
+void PerfRegressionCheck::importLog(const std::string& path, const std::string& region) {
+    std::ifstream ifs(path);
+    if (!ifs) throw std::runtime_error("cannot open log file: " + path);
+    std::string line;
+    size_t line_no = 0;
+    // 先完整解析再合并，出错时不留下半份数据
+    std::vector<std::pair<std::string, uint64_t>> parsed;
+    while (std::getline(ifs, line)) {
+        ++line_no;
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+        const std::string where = path + ":" + std::to_string(line_no) + ": ";
+        size_t pos = line.rfind(':');
+        if (pos == std::string::npos) throw std::runtime_error(where + "expected \"EVENT: value\"");
+        std::string event = line.substr(0, pos);
+        std::string value_text = line.substr(pos + 1);
+        value_text.erase(0, value_text.find_first_not_of(" \t"));
+        std::istringstream iss(value_text);
+        std::string token, extra;
+        uint64_t value = 0;
+        if (!(iss >> token) || (iss >> extra) || !parseUnsigned(token, value)) {
+            throw std::runtime_error(where + "invalid sample value for " + event + ": \"" + value_text + "\"");
+        }
+        if (!isValidName(event)) throw std::runtime_error(where + "invalid event name: " + event);
+        parsed.push_back({event, value});
+    }
+    if (!isValidName(region)) throw std::runtime_error("invalid region name: " + region);
+    for (const auto& kv : parsed) {
+        samples_[region][kv.first].push_back(kv.second);
+    }
+}
+
+double PerfRegressionCheck::median(std::vector<uint64_t> values) {
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    if (n % 2 == 1) return static_cast<double>(values[n / 2]);
+    return 0.5 * (static_cast<double>(values[n / 2 - 1]) + static_cast<double>(values[n / 2]));
+}
+
+double PerfRegressionCheck::mannWhitneyGreater(const std::vector<uint64_t>& sample_a, const std::vector<uint64_t>& sample_b) {
+    const size_t n1 = sample_a.size();
+    const size_t n2 = sample_b.size();
+    if (n1 == 0 || n2 == 0) return 1.0;
+
+    // 合并排序后求秩，相同值取平均秩
+    std::vector<std::pair<uint64_t, int>> all; // (值, 所属样本：0为a，1为b)
+    all.reserve(n1 + n2);
+    for (uint64_t v : sample_a) all.push_back({v, 0});
+    for (uint64_t v : sample_b) all.push_back({v, 1});
+    std::sort(all.begin(), all.end());
+
+    const double n = static_cast<double>(n1 + n2);
+    double rank_sum_b = 0.0;
+    double tie_term = 0.0; // sum(t^3 - t)
+    std::vector<size_t> ranks2; // 2倍平均秩，保证为整数
+    ranks2.reserve(all.size());
+    size_t rank2_sum_b = 0;
+    size_t i = 0;
+    while (i < all.size()) {
+        size_t j = i;
+        while (j < all.size() && all[j].first == all[i].first) ++j;
+        double avg_rank = 0.5 * static_cast<double>(i + 1 + j); // 秩从1开始
+        for (size_t k = i; k < j; ++k) {
+            ranks2.push_back(i + 1 + j);
+            if (all[k].second == 1) {
+                rank_sum_b += avg_rank;
+                rank2_sum_b += i + 1 + j;
+            }
+        }
+        double t = static_cast<double>(j - i);
+        tie_term += t * t * t - t;
+        i = j;
+    }
+
+    if (n1 <= kExactMaxRuns && n2 <= kExactMaxRuns) {
+        // 精确置换分布：ways[k][s]为从全部样本中选k个、2倍秩和为s的组合数
+        size_t max_sum = 0;
+        for (size_t r : ranks2) max_sum += r;
+        std::vector<std::vector<double>> ways(n2 + 1, std::vector<double>(max_sum + 1, 0.0));
+        ways[0][0] = 1.0;
+        for (size_t idx = 0; idx < ranks2.size(); ++idx) {
+            size_t r = ranks2[idx];
+            for (size_t k = std::min(idx + 1, n2); k >= 1; --k) {
+                for (size_t s = max_sum; s >= r; --s) {
+                    ways[k][s] += ways[k - 1][s - r];
+                }
+            }
+        }
+        double total = 0.0, tail = 0.0;
+        for (size_t s = 0; s <= max_sum; ++s) {
+            total += ways[n2][s];
+            if (s >= rank2_sum_b) tail += ways[n2][s];
+        }
+        return tail / total;
+    }
+
+    const double u_b = rank_sum_b - static_cast<double>(n2) * (n2 + 1) / 2.0;
+    const double mean_u = static_cast<double>(n1) * n2 / 2.0;
+    const double var_u = static_cast<double>(n1) * n2 / 12.0 * ((n + 1.0) - tie_term / (n * (n - 1.0)));
+    if (var_u <= 0.0) return 1.0; // 全部样本相同
+
+    // 连续性修正后的单侧正态近似
+    double z = (u_b - mean_u - 0.5) / std::sqrt(var_u);
+    return 0.5 * std::erfc(z / std::sqrt(2.0));
+}
+
+double PerfRegressionCheck::minAttainablePValue(size_t n1, size_t n2) {
+    // C(n1+n2, n1) = prod_{k=1..n1} (n2+k)/k
+    double combinations = 1.0;
+    for (size_t k = 1; k <= n1; ++k) {
+        combinations = combinations * static_cast<double>(n2 + k) / static_cast<double>(k);
+    }
+    return 1.0 / combinations;
+}
+
+std::vector<PerfRegressionCheck::MetricDiff> PerfRegressionCheck::compare(const PerfRegressionCheck& baseline, const Thresholds& thresholds) const {
+    validateThresholds(thresholds);
+    std::vector<MetricDiff> diffs;
+
+    // 基线中的指标：OK / REGRESSION / IMPROVED / MISSING
+    for (const auto& r : baseline.samples_) {
+        for (const auto& e : r.second) {
+            MetricDiff d;
+            d.region = r.first;
+            d.event = e.first;
+            d.baseline_runs = e.second.size();
+            d.baseline_median = median(e.second);
+            d.current_runs = 0;
+            d.current_median = 0.0;
+            d.rel_change = 0.0;
+            d.p_value = 1.0;
+            d.status = Status::MISSING;
+            d.failed = !thresholds.allow_missing;
+            d.threshold_only = false;
+            d.note = thresholds.allow_missing ? "missing allowed" : "not recorded in current run";
+
+            std::vector<uint64_t> cur = getSamples(r.first, e.first);
+            if (!cur.empty()) {
+                d.current_runs = cur.size();
+                d.current_median = median(cur);
+                if (d.baseline_median > 0.0) {
+                    d.rel_change = (d.current_median - d.baseline_median) / d.baseline_median;
+                } else if (d.current_median > 0.0) {
+                    d.rel_change = INFINITY;
+                }
+
+                auto th_it = thresholds.per_event.find(e.first);
+                double rel_threshold = (th_it != thresholds.per_event.end()) ? th_it->second : thresholds.rel_threshold;
+
+                // 样本太少时检验不可能显著，退化为只看相对变化阈值
+                d.status = Status::OK;
+                d.failed = false;
+                d.note.clear();
+                d.threshold_only = false;
+                if (d.baseline_runs < thresholds.min_runs || d.current_runs < thresholds.min_runs) {
+                    d.threshold_only = true;
+                    d.note = "fewer than " + std::to_string(thresholds.min_runs) + " runs, threshold only";
+                } else if (minAttainablePValue(d.baseline_runs, d.current_runs) >= thresholds.alpha) {
+                    d.threshold_only = true;
+                    d.note = "too few runs for alpha, threshold only";
+                }
+
+                // 计数器均为"越少越好"，按变化方向选择单侧检验
+                if (d.rel_change >= 0.0) {
+                    d.p_value = mannWhitneyGreater(e.second, cur);
+                    if ((d.threshold_only || d.p_value < thresholds.alpha) && d.rel_change > rel_threshold) {
+                        d.status = Status::REGRESSION;
+                        d.failed = true;
+                    }
+                } else {
+                    d.p_value = mannWhitneyGreater(cur, e.second);
+                    if ((d.threshold_only || d.p_value < thresholds.alpha) && -d.rel_change > rel_threshold) d.status = Status::IMPROVED;
+                }
+            }
+            diffs.push_back(d);
+        }
+    }
+
+    // 仅本次运行中有的指标：NEW
+    for (const auto& r : samples_) {
+        for (const auto& e : r.second) {
+            if (!baseline.getSamples(r.first, e.first).empty()) continue;
+            MetricDiff d;
+            d.region = r.first;
+            d.event = e.first;
+            d.baseline_runs = 0;
+            d.baseline_median = 0.0;
+            d.current_runs = e.second.size();
+            d.current_median = median(e.second);
+            d.rel_change = 0.0;
+            d.p_value = 1.0;
+            d.status = Status::NEW;
+            d.failed = false;
+            d.threshold_only = false;
+            d.note = "not in baseline";
+            diffs.push_back(d);
+        }
+    }
+
+    std::sort(diffs.begin(), diffs.end(), [](const MetricDiff& a, const MetricDiff& b) {
+        return a.region != b.region ? a.region < b.region : a.event < b.event;
+    });
+    return diffs;
+}
+
+std::vector<PerfRegressionCheck::MetricDiff> PerfRegressionCheck::compare(const PerfRegressionCheck& baseline) const {
+    return compare(baseline, Thresholds());
+}
+
+bool PerfRegressionCheck::hasRegression(const std::vector<MetricDiff>& diffs) {
+    for (const auto& d : diffs) {
+        if (d.failed) return true;
+    }
+    return false;
+}
+
+std::string PerfRegressionCheck::statusToString(Status status) {
+    switch(status) {
+        case Status::OK: return "OK";
+        case Status::REGRESSION: return "REGRESSION";
+        case Status::IMPROVED: return "IMPROVED";
+        case Status::MISSING: return "MISSING";
+        case Status::NEW: return "NEW";
+        default: return "UNKNOWN";
+    }
+}
+
+void PerfRegressionCheck::printSummary(std::ostream& os) const {
+    size_t region_w = 6, event_w = 5;
+    for (const auto& r : samples_) {
+        region_w = std::max(region_w, r.first.size());
+        for (const auto& e : r.second) event_w = std::max(event_w, e.first.size());
+    }
+
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << std::left << std::setw(region_w) << "region" << "  "
+       << std::setw(event_w) << "event" << "  "
+       << std::right << std::setw(5) << "runs" << "  "
+       << std::setw(16) << "median" << "  "
+       << std::setw(16) << "min" << "  "
+       << std::setw(16) << "max" << std::endl;
+    for (const auto& r : samples_) {
+        for (const auto& e : r.second) {
+            auto minmax = std::minmax_element(e.second.begin(), e.second.end());
+            os << std::left << std::setw(region_w) << r.first << "  "
+               << std::setw(event_w) << e.first << "  "
+               << std::right << std::setw(5) << e.second.size() << "  "
+               << std::fixed << std::setprecision(1) << std::setw(16) << median(e.second) << "  "
+               << std::setw(16) << (e.second.empty() ? 0 : *minmax.first) << "  "
+               << std::setw(16) << (e.second.empty() ? 0 : *minmax.second) << std::endl;
+        }
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
+
+void PerfRegressionCheck::printDiffTable(const std::vector<MetricDiff>& diffs, std::ostream& os) {
+    size_t region_w = 6, event_w = 5;
+    for (const auto& d : diffs) {
+        region_w = std::max(region_w, d.region.size());
+        event_w = std::max(event_w, d.event.size());
+    }
+
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision();
+    os << std::left << std::setw(region_w) << "region" << "  "
+       << std::setw(event_w) << "event" << "  "
+       << std::right << std::setw(16) << "baseline" << "  "
+       << std::setw(16) << "current" << "  "
+       << std::setw(9) << "change" << "  "
+       << std::setw(9) << "p-value" << "  "
+       << std::setw(7) << "runs" << "  "
+       << std::left << std::setw(10) << "status" << "  "
+       << "note" << std::endl;
+    for (const auto& d : diffs) {
+        std::ostringstream change, p, runs;
+        if (d.status == Status::MISSING || d.status == Status::NEW) {
+            change << "-";
+            p << "-";
+        } else {
+            change << std::showpos << std::fixed << std::setprecision(2) << d.rel_change * 100.0 << "%";
+            p << std::fixed << std::setprecision(4) << d.p_value;
+        }
+        runs << d.baseline_runs << "/" << d.current_runs;
+        os << std::left << std::setw(region_w) << d.region << "  "
+           << std::setw(event_w) << d.event << "  "
+           << std::right << std::fixed << std::setprecision(1)
+           << std::setw(16) << d.baseline_median << "  "
+           << std::setw(16) << d.current_median << "  "
+           << std::setw(9) << change.str() << "  "
+           << std::setw(9) << p.str() << "  "
+           << std::setw(7) << runs.str() << "  "
+           << std::left;
+        if (d.note.empty()) {
+            os << statusToString(d.status) << std::endl;
+        } else {
+            os << std::setw(10) << statusToString(d.status) << "  " << d.note << std::endl;
+        }
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
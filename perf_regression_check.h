@@ -0,0 +1,199 @@
+#ifndef PERF_REGRESSION_CHECK_H
+#define PERF_REGRESSION_CHECK_H
+
+#include <vector>
+#include <string>
+#include <map>
+#include <ostream>
+#include <stdint.h>
+
+class PerfEventOpenTool;
+
+/**
+ * @brief 性能回归检查工具类。
+ *
+ * 按"区域(region) -> 事件(event)"保存多次运行的计数分布，可存为基线文件，
+ * 新一轮运行的分布与基线做单侧Mann-Whitney U检验，并结合中位数相对变化阈值判定回归。
+ * 运行次数少于Thresholds::min_runs，或次数太少使检验在alpha下不可能显著时，
+ * 只按中位数相对变化阈值判定，并在差异表中注明。
+ * 指令数等计数器比墙钟时间稳定得多，能发现计时检查发现不了的小幅回归。
+ *
+ * 基线文件为文本格式，每行一个指标：
+ * @code
+ * # perf_regression_baseline v1
+ * <region> <event> <n> <v1> <v2> ... <vn>
+ * @endcode
+ * 首行为版本头，之后以#开头的行为注释。region和event中不能包含空白字符，同一指标出现多行时样本合并。
+ */
+class PerfRegressionCheck {
+public:
+    /**
+     * @brief 单个指标的判定结果
+     */
+    enum class Status {
+        OK,         // 无显著变化
+        REGRESSION, // 显著变差（计数增加超过阈值）
+        IMPROVED,   // 显著变好（计数减少超过阈值）
+        MISSING,    // 基线中有、本次运行中没有（默认视为失败）
+        NEW         // 本次运行中有、基线中没有
+    };
+
+    /**
+     * @brief 单个指标的对比结果，对应差异表中的一行
+     */
+    struct MetricDiff {
+        std::string region;
+        std::string event;
+        size_t baseline_runs;
+        size_t current_runs;
+        double baseline_median;
+        double current_median;
+        double rel_change; // (current_median - baseline_median) / baseline_median
+        double p_value;    // 单侧检验p值（按变化方向）
+        Status status;
+        bool failed;       // 是否导致检查失败
+        bool threshold_only; // 运行次数不足以做检验，仅按相对变化阈值判定
+        std::string note;  // 判定说明，输出在差异表最后一列
+    };
+
+    /**
+     * @brief 判定阈值配置
+     */
+    struct Thresholds {
+        double alpha = 0.05;            // 显著性水平
+        double rel_threshold = 0.01;    // 默认中位数相对变化阈值（1%）
+        std::map<std::string, double> per_event; // 按事件名覆盖rel_threshold
+        bool allow_missing = false;     // 为true时MISSING不视为失败
+        size_t min_runs = 4;            // 任一侧运行次数少于此值时不做检验，只按相对变化阈值判定
+    };
+
+    PerfRegressionCheck() = default;
+
+    /**
+     * @brief 追加一次运行的计数结果
+     * @param region 区域名（被测代码段）
+     * @param results 事件名到计数值的映射，如getResults()的返回值
+     */
+    void addRun(const std::string& region, const std::map<std::string, uint64_t>& results);
+
+    /**
+     * @brief 追加一次运行的计数结果，直接从已stop()的PerfEventOpenTool中读取
+     *
+     * 按getResultsByName()记录：有自定义名字的事件用自定义名字，其余用事件类型名。
+     * 与logResults()写出的名字一致，因此addRun()与 perf_regress import 得到的基线可以互相对比。
+     * @param region 区域名
+     * @param tool 已完成统计的工具对象
+     */
+    void addRun(const std::string& region, const PerfEventOpenTool& tool);
+
+    /**
+     * @brief 追加单个指标的一个样本
+     */
+    void addSample(const std::string& region, const std::string& event, uint64_t value);
+
+    /**
+     * @brief 获取某个指标的全部样本（不存在时返回空数组）
+     */
+    std::vector<uint64_t> getSamples(const std::string& region, const std::string& event) const;
+
+    /**
+     * @brief 获取某个区域下所有事件名（区域不存在时返回空数组）
+     */
+    std::vector<std::string> getEvents(const std::string& region) const;
+
+    /**
+     * @brief 是否没有任何样本
+     */
+    bool empty() const;
+
+    /**
+     * @brief 清空所有样本
+     */
+    void clear();
+
+    /**
+     * @brief 保存为基线文件（覆盖写）
+     * @param path 文件路径
+     */
+    void save(const std::string& path) const;
+
+    /**
+     * @brief 从基线文件加载，样本追加到当前对象中
+     *
+     * 首行须为版本头；样本数须为正且与实际样本个数一致，数值只接受无符号十进制整数。
+     * @param path 文件路径
+     * @throws std::runtime_error 文件无法打开或格式错误时（此时对象不被修改）
+     */
+    void load(const std::string& path);
+
+    /**
+     * @brief 导入logResults()写出的日志，样本追加到指定region中
+     *
+     * 日志每行为"EVENT: value"，多次运行追加到同一文件即得到分布；空行被忽略。
+     * value只接受无符号十进制整数。
+     * @param path 日志文件路径
+     * @param region 区域名
+     * @throws std::runtime_error 文件无法打开或某行格式错误时（附文件名和行号，此时对象不被修改）
+     */
+    void importLog(const std::string& path, const std::string& region);
+
+    /**
+     * @brief 将本对象（本次运行）与基线对比
+     * @param baseline 基线
+     * @param thresholds 判定阈值
+     * @return 每个指标的对比结果，按region、event排序
+     * @throws std::runtime_error alpha不在(0,1)内或相对变化阈值为负数/NaN时
+     */
+    std::vector<MetricDiff> compare(const PerfRegressionCheck& baseline, const Thresholds& thresholds) const;
+
+    /**
+     * @brief 使用默认阈值与基线对比
+     */
+    std::vector<MetricDiff> compare(const PerfRegressionCheck& baseline) const;
+
+    /**
+     * @brief 对比结果中是否存在导致失败的指标（REGRESSION，以及未允许时的MISSING）
+     */
+    static bool hasRegression(const std::vector<MetricDiff>& diffs);
+
+    /**
+     * @brief 输出差异表
+     */
+    static void printDiffTable(const std::vector<MetricDiff>& diffs, std::ostream& os);
+
+    /**
+     * @brief 输出所有指标的样本概况：region、event、运行次数、中位数、最小值、最大值
+     */
+    void printSummary(std::ostream& os) const;
+
+    /**
+     * @brief 状态转字符串
+     */
+    static std::string statusToString(Status status);
+
+    /**
+     * @brief 精确计算Mann-Whitney U检验p值的最大单组样本量
+     */
+    static const size_t kExactMaxRuns = 10;
+
+    /**
+     * @brief 单侧Mann-Whitney U检验
+     *
+     * 备择假设为sample_b整体大于sample_a。两组样本量均不超过kExactMaxRuns时
+     * 按平均秩枚举精确置换分布（含结），否则用含结修正与连续性修正的正态近似。
+     * @return p值，样本为空或全部相同时返回1.0
+     */
+    static double mannWhitneyGreater(const std::vector<uint64_t>& sample_a, const std::vector<uint64_t>& sample_b);
+
+    /**
+     * @brief 两组样本量下单侧Mann-Whitney U检验可达到的最小p值，即1/C(n1+n2, n1)
+     */
+    static double minAttainablePValue(size_t n1, size_t n2);
+
+private:
+    // region -> event -> 多次运行的样本
+    std::map<std::string, std::map<std::string, std::vector<uint64_t>>> samples_;
+    static double median(std::vector<uint64_t> values);
+};
+
+#endif // PERF_REGRESSION_CHECK_H
@@ -0,0 +1,215 @@
+// PerfRegressionCheck 统计判定的自检程序，make test 运行，失败时返回1
+#include "perf_regression_check.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <stdexcept>
+#include <fstream>
+
+namespace {
+    int failures = 0;
+
+    void check(bool cond, const std::string& what) {
+        if (!cond) {
+            std::cerr << "FAIL: " << what << std::endl;
+            ++failures;
+        }
+    }
+
+    template <typename F>
+    void checkThrows(F f, const std::string& what) {
+        try {
+            f();
+        } catch (const std::runtime_error&) {
+            return;
+        }
+        std::cerr << "FAIL: " << what << ": no exception" << std::endl;
+        ++failures;
+    }
+
+    void checkNear(double actual, double expected, double tol, const std::string& what) {
+        if (std::fabs(actual - expected) > tol) {
+            std::cerr << "FAIL: " << what << ": expected " << expected << ", got " << actual << std::endl;
+            ++failures;
+        }
+    }
+
+    // 暴力枚举所有分组，计算sample_b秩和不小于观测值的比例，用于核对精确分布
+    double bruteForceGreater(const std::vector<uint64_t>& a, const std::vector<uint64_t>& b) {
+        std::vector<uint64_t> all(a);
+        all.insert(all.end(), b.begin(), b.end());
+        const size_t n = all.size();
+        std::vector<double> rank(n);
+        for (size_t i = 0; i < n; ++i) {
+            double less = 0, equal = 0;
+            for (size_t j = 0; j < n; ++j) {
+                if (all[j] < all[i]) ++less;
+                else if (all[j] == all[i]) ++equal;
+            }
+            rank[i] = less + (equal + 1) / 2.0;
+        }
+        double observed = 0;
+        for (size_t i = a.size(); i < n; ++i) observed += rank[i];
+        double total = 0, tail = 0;
+        for (unsigned mask = 0; mask < (1u << n); ++mask) {
+            if (static_cast<size_t>(__builtin_popcount(mask)) != b.size()) continue;
+            double sum = 0;
+            for (size_t i = 0; i < n; ++i) if (mask & (1u << i)) sum += rank[i];
+            ++total;
+            if (sum >= observed - 1e-9) ++tail;
+        }
+        return tail / total;
+    }
+
+    PerfRegressionCheck makeRun(const std::string& event, const std::vector<uint64_t>& values) {
+        PerfRegressionCheck run;
+        for (uint64_t v : values) run.addSample("region", event, v);
+        return run;
+    }
+
+    void testExactPValues() {
+        using P = PerfRegressionCheck;
+        checkNear(P::mannWhitneyGreater({1, 2, 3}, {4, 5, 6}), 0.05, 1e-12, "{1,2,3} vs {4,5,6}");
+        checkNear(P::mannWhitneyGreater({1, 2, 3, 4}, {5, 6, 7, 8}), 1.0 / 70, 1e-12, "{1..4} vs {5..8}");
+        checkNear(P::mannWhitneyGreater({4, 5, 6}, {1, 2, 3}), 1.0, 1e-12, "reversed samples");
+        checkNear(P::mannWhitneyGreater({7, 7, 7}, {7, 7, 7}), 1.0, 1e-12, "all samples tied");
+        checkNear(P::mannWhitneyGreater({1000, 1000, 1000, 1000, 1000}, {1010, 1010, 1010, 1010, 1010}),
+                  1.0 / 252, 1e-12, "deterministic counts");
+        checkNear(P::mannWhitneyGreater({1}, {2}), 0.5, 1e-12, "single run each");
+        checkNear(P::minAttainablePValue(3, 3), 0.05, 1e-12, "min attainable p for 3/3");
+        checkNear(P::minAttainablePValue(1, 1), 0.5, 1e-12, "min attainable p for 1/1");
+
+        // 含结的样本与暴力枚举对比
+        std::vector<std::vector<uint64_t>> a_cases = {{1, 1, 2}, {3, 5, 5, 8}, {10, 10, 12, 12, 15}, {2, 4, 4, 6, 9, 9}};
+        std::vector<std::vector<uint64_t>> b_cases = {{2, 3, 3}, {5, 6, 8, 8, 9}, {12, 13, 15, 15}, {4, 9, 9, 10, 11}};
+        for (size_t i = 0; i < a_cases.size(); ++i) {
+            checkNear(P::mannWhitneyGreater(a_cases[i], b_cases[i]), bruteForceGreater(a_cases[i], b_cases[i]), 1e-12,
+                      "exact p with ties, case " + std::to_string(i));
+        }
+    }
+
+    void testNormalApproximation() {
+        std::vector<uint64_t> a, b;
+        for (uint64_t v = 0; v < 15; ++v) {
+            a.push_back(v);
+            b.push_back(v + 15);
+        }
+        check(PerfRegressionCheck::mannWhitneyGreater(a, b) < 1e-4, "large disjoint samples are significant");
+        check(PerfRegressionCheck::mannWhitneyGreater(b, a) > 0.999, "large reversed samples are not significant");
+    }
+
+    void testCompare() {
+        using P = PerfRegressionCheck;
+        P baseline = makeRun("INSTRUCTIONS", {1000, 1001, 1000, 1002, 1000});
+
+        auto diffs = makeRun("INSTRUCTIONS", {1020, 1021, 1020, 1022, 1019}).compare(baseline);
+        check(diffs.size() == 1 && diffs[0].status == P::Status::REGRESSION && P::hasRegression(diffs), "2% increase is a regression");
+
+        diffs = makeRun("INSTRUCTIONS", {1000, 1001, 1000, 1002, 1000}).compare(baseline);
+        check(diffs.size() == 1 && diffs[0].status == P::Status::OK && !P::hasRegression(diffs), "identical runs pass");
+
+        diffs = P().compare(baseline);
+        check(diffs.size() == 1 && diffs[0].status == P::Status::MISSING && P::hasRegression(diffs), "missing metric fails");
+        P::Thresholds allow;
+        allow.allow_missing = true;
+        check(!P::hasRegression(P().compare(baseline, allow)), "missing metric passes with allow_missing");
+
+        diffs = makeRun("CACHE_MISSES", {5000}).compare(makeRun("CACHE_MISSES", {500}));
+        check(diffs.size() == 1 && diffs[0].threshold_only && diffs[0].status == P::Status::REGRESSION,
+              "single run falls back to threshold rule");
+    }
+
+    void writeFile(const std::string& path, const std::string& content) {
+        std::ofstream ofs(path, std::ios::trunc);
+        ofs << content;
+    }
+
+    void testLoad() {
+        using P = PerfRegressionCheck;
+        const std::string path = "perf_regression_check_test.tmp";
+        const std::string header = "# perf_regression_baseline v1\n";
+
+        P saved = makeRun("INSTRUCTIONS", {1000, 18446744073709551615ULL});
+        saved.save(path);
+        P loaded;
+        loaded.load(path);
+        check(loaded.getSamples("region", "INSTRUCTIONS") == saved.getSamples("region", "INSTRUCTIONS"), "save/load round trip");
+
+        std::vector<std::string> bad = {
+            "r e 1 5\n",                      // 缺少版本头
+            "# perf_regression_baseline v2\nr e 1 5\n",
+            header + "r e 1 -5\n",            // 负数
+            header + "r e -1 5\n",
+            header + "r e 1 5 6\n",           // 多余样本
+            header + "r e 2 5\n",             // 样本不足
+            header + "r e 0\n",               // 空样本
+            header + "r e 1 5x\n",
+            header + "r e 1 18446744073709551616\n", // 溢出
+        };
+        for (size_t i = 0; i < bad.size(); ++i) {
+            writeFile(path, bad[i]);
+            P check_load;
+            checkThrows([&] { check_load.load(path); }, "malformed baseline case " + std::to_string(i));
+            check(check_load.empty(), "failed load leaves object empty, case " + std::to_string(i));
+        }
+        std::remove(path.c_str());
+    }
+
+    void testImportLog() {
+        using P = PerfRegressionCheck;
+        const std::string path = "perf_regression_check_test.log";
+
+        writeFile(path, "INSTRUCTIONS: 100\nCACHE_MISSES: 7\n\nINSTRUCTIONS: 101\nCACHE_MISSES: 8\n");
+        P imported;
+        imported.importLog(path, "r");
+        check(imported.getSamples("r", "INSTRUCTIONS") == std::vector<uint64_t>({100, 101}), "import INSTRUCTIONS samples");
+        check(imported.getSamples("r", "CACHE_MISSES") == std::vector<uint64_t>({7, 8}), "import CACHE_MISSES samples");
+
+        // 单事件日志中的坏行不能被静默丢弃
+        std::vector<std::string> bad_values = {"-5", "12abc", "1e6", "18446744073709551616", "", "1 2"};
+        for (const auto& v : bad_values) {
+            writeFile(path, "INSTRUCTIONS: 100\nINSTRUCTIONS: " + v + "\nINSTRUCTIONS: 101\n");
+            P check_import;
+            checkThrows([&] { check_import.importLog(path, "r"); }, "single-event log with bad value '" + v + "'");
+            check(check_import.empty(), "failed import leaves object empty, value '" + v + "'");
+        }
+        writeFile(path, "INSTRUCTIONS: 100\nnot a sample\n");
+        P check_import;
+        checkThrows([&] { check_import.importLog(path, "r"); }, "log line without colon");
+        std::remove(path.c_str());
+    }
+
+    void testInvalidThresholds() {
+        using P = PerfRegressionCheck;
+        P baseline = makeRun("INSTRUCTIONS", {1000, 1001, 1000, 1002});
+        P::Thresholds th;
+        th.alpha = -1.0;
+        checkThrows([&] { baseline.compare(baseline, th); }, "negative alpha");
+        th.alpha = 1.0;
+        checkThrows([&] { baseline.compare(baseline, th); }, "alpha of 1");
+        th = P::Thresholds();
+        th.rel_threshold = -0.01;
+        checkThrows([&] { baseline.compare(baseline, th); }, "negative threshold");
+        th = P::Thresholds();
+        th.per_event["INSTRUCTIONS"] = std::nan("");
+        checkThrows([&] { baseline.compare(baseline, th); }, "NaN per-event threshold");
+    }
+}
+
+int main() {
+    testExactPValues();
+    testNormalApproximation();
+    testCompare();
+    testInvalidThresholds();
+    testLoad();
+    testImportLog();
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "all checks passed" << std::endl;
+    return 0;
+}